@@ -0,0 +1,118 @@
+# RAM and flash budget check for the firmware.
+#
+# After every link the sizes of the ELF are checked against the budgets from
+# platformio.ini and the build fails when one is exceeded:
+#
+#   RAM    .data + .bss + .noinit must leave custom_stack_reserve bytes for the stack.
+#   flash  .text + .data must fit in custom_flash_budget, by default the board's upload.maximum_size.
+#   heap   malloc() must not be linked in, everything is allocated statically.
+#
+# `pio run -t footprint` prints the usage per symbol as well.
+
+Import("env")
+
+import os
+import subprocess
+
+RAM_OFFSET = 0x800000  # avr-gcc places RAM addresses at 0x800000 and up.
+
+
+def tool(name):
+    # avr-gcc -> avr-nm, avr-size
+    cc = env.subst("$CC")
+    return os.path.join(os.path.dirname(cc), os.path.basename(cc).replace("gcc", name))
+
+
+def run(args):
+    # The toolchain is only on the PATH that PlatformIO gives to SCons, not on the one of this process.
+    return subprocess.check_output(args, env=dict(os.environ, PATH=env["ENV"]["PATH"]), universal_newlines=True)
+
+
+def budgets():
+    board = env.BoardConfig()
+    ram = int(board.get("upload.maximum_ram_size", 2048))
+    stack = int(env.GetProjectOption("custom_stack_reserve", 512))
+    flash = int(env.GetProjectOption("custom_flash_budget", board.get("upload.maximum_size", 30720)))
+    return ram, stack, flash
+
+
+def sections(elf):
+    out = run([tool("size"), "-A", elf])
+    sizes = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def symbols(elf):
+    out = run([tool("nm"), "-S", "-C", "--size-sort", elf])
+    result = []
+    for line in out.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4:
+            address, size, kind, name = fields
+            result.append((int(address, 16), int(size, 16), kind, name))
+    return result
+
+
+def usage(elf):
+    sizes = sections(elf)
+    data = sizes.get(".data", 0)
+    ram = data + sizes.get(".bss", 0) + sizes.get(".noinit", 0)
+    flash = sizes.get(".text", 0) + data
+    return ram, flash
+
+
+def check(elf):
+    ram_size, stack_reserve, flash_budget = budgets()
+    ram_budget = ram_size - stack_reserve
+    ram, flash = usage(elf)
+    heap = [name for _, _, _, name in symbols(elf) if name in ("malloc", "realloc", "calloc")]
+
+    print("Footprint: RAM %d of %d bytes (%d reserved for the stack), flash %d of %d bytes"
+          % (ram, ram_budget, stack_reserve, flash, flash_budget))
+    errors = []
+    if ram > ram_budget:
+        errors.append("static RAM %d bytes exceeds the budget of %d bytes" % (ram, ram_budget))
+    if flash > flash_budget:
+        errors.append("flash %d bytes exceeds the budget of %d bytes" % (flash, flash_budget))
+    if heap:
+        errors.append("heap allocation linked in (%s), allocate statically" % ", ".join(heap))
+    for e in errors:
+        print("Footprint: ERROR: " + e)
+    return 1 if errors else 0
+
+
+def check_action(target, source, env):
+    return check(target[0].get_abspath())
+
+
+def report_action(target, source, env):
+    elf = env.subst("$BUILD_DIR/${PROGNAME}.elf")
+    ram_symbols = []
+    flash_symbols = []
+    for address, size, kind, name in symbols(elf):
+        if address >= RAM_OFFSET:
+            ram_symbols.append((size, kind, name))
+        elif kind.lower() in ("t", "w", "r"):
+            flash_symbols.append((size, kind, name))
+    print("\nRAM (.data symbols also take their initial value in flash)")
+    for size, kind, name in sorted(ram_symbols, reverse=True):
+        print("  %6d  %s  %s" % (size, "data" if kind.lower() == "d" else "bss ", name))
+    print("\nFlash")
+    for size, kind, name in sorted(flash_symbols, reverse=True):
+        print("  %6d  %s" % (size, name))
+    print("")
+    return check(elf)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_action)
+
+env.AddCustomTarget(
+    name="footprint",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions=[report_action],
+    title="Footprint",
+    description="RAM and flash usage per symbol, checked against the budgets")
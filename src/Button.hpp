@@ -0,0 +1,174 @@
+#ifndef _BUTTON
+#define _BUTTON
+
+/*
+ * Interrupt driven push button with click, double click and long press.
+ *
+ * The pin change interrupt stamps every change of the pin with millis(). As
+ * with OneButton, a level only counts once it has held for DEBOUNCE_MS, so
+ * bounce and glitches shorter than that never reach the gesture recognition.
+ * A level that held long enough is taken at the next pin change, in the
+ * interrupt, or by tick(), whichever comes first, with the time it started;
+ * finished gestures go into a small queue that loop() empties with getEvent().
+ * tick() also decides that a single click was not followed by a second one.
+ * While the button is left alone tick() returns immediately.
+ *
+ * Timing matches what the OneButton library did here before: 50 ms debounce,
+ * 400 ms to start a double click and 800 ms for a long press.
+ */
+
+enum ButtonEvent {
+  BUTTON_NONE,
+  BUTTON_CLICK,
+  BUTTON_DOUBLE_CLICK,
+  BUTTON_LONG_PRESS_STOP
+};
+
+class Button {
+
+  private:
+    static const unsigned long DEBOUNCE_MS = 50;    // A level must hold this long to count.
+    static const unsigned long CLICK_MS = 400;      // Time after a click in which a second press makes a double click.
+    static const unsigned long LONG_PRESS_MS = 800; // Holding down this long makes a long press.
+    static const uint8_t QUEUE_SIZE = 4;            // Must be a power of 2.
+
+    enum State : uint8_t {
+      IDLE,           // Waiting for the first press.
+      PRESSED,        // First press is down.
+      RELEASED,       // First press came up, a second one would make a double click.
+      PRESSED_AGAIN   // Second press is down.
+    };
+
+    int pin;
+    bool activeHigh;
+
+    volatile State state = IDLE;
+    volatile bool pressed = false;         // The debounced button state.
+    volatile bool level = false;           // The latest level seen on the pin.
+    volatile unsigned long levelSince = 0; // When the pin changed to level.
+    volatile bool settling = false;        // level has not been taken yet.
+    volatile unsigned long pressTime = 0;
+    volatile unsigned long releaseTime = 0;
+
+    volatile uint8_t events[QUEUE_SIZE];
+    volatile uint8_t head = 0; // Next event to be read.
+    volatile uint8_t tail = 0; // Next free slot.
+
+    // Queue an event, a full queue drops it. Call with interrupts disabled.
+    void push(ButtonEvent e) {
+      uint8_t next = ( tail + 1 ) & ( QUEUE_SIZE - 1 );
+      if ( next != head ) {
+        events[tail] = e;
+        tail = next;
+      }
+    }
+
+    // The gesture state machine, runs on every debounced edge. Call with interrupts disabled.
+    void edge(bool down, unsigned long now) {
+      pressed = down;
+      switch (state) {
+        case IDLE:
+          if ( down ) {
+            state = PRESSED;
+            pressTime = now;
+          }
+          break;
+        case PRESSED:
+          if ( !down ) {
+            if ( now - pressTime >= LONG_PRESS_MS ) {
+              push(BUTTON_LONG_PRESS_STOP);
+              state = IDLE;
+            } else {
+              state = RELEASED;
+              releaseTime = now;
+            }
+          }
+          break;
+        case RELEASED:
+          if ( down ) {
+            if ( now - releaseTime >= CLICK_MS ) { // tick() has not been called in time.
+              push(BUTTON_CLICK);
+              state = PRESSED;
+            } else {
+              state = PRESSED_AGAIN;
+            }
+            pressTime = now;
+          }
+          break;
+        case PRESSED_AGAIN:
+          if ( !down ) {
+            push(BUTTON_DOUBLE_CLICK);
+            state = IDLE;
+          }
+          break;
+      }
+    }
+
+    // Take the latest level once it has held for DEBOUNCE_MS. Call with interrupts disabled.
+    void settle(unsigned long now) {
+      if ( settling && ( now - levelSince >= DEBOUNCE_MS ) ) {
+        settling = false;
+        if ( level != pressed ) {
+          edge(level, levelSince);
+        }
+      }
+    }
+
+    bool readPin() {
+      return digitalRead(pin) == ( activeHigh ? HIGH : LOW );
+    }
+
+  public:
+
+    Button(int _pin, bool _activeHigh):
+           pin(_pin),
+           activeHigh(_activeHigh) {}
+
+    // isr must be a plain function that calls handleInterrupt() on this button.
+    void begin(void (*isr)()) {
+      // Same pin setup as OneButton used: pull-up on, the hardware pulls the idle pin down.
+      pinMode(pin, INPUT_PULLUP);
+      pressed = readPin();
+      level = pressed;
+      attachInterrupt(digitalPinToInterrupt(pin), isr, CHANGE);
+    }
+
+    // Pin change interrupt.
+    void handleInterrupt() {
+      unsigned long now = millis();
+      settle(now);
+      bool down = readPin();
+      if ( down != level ) {
+        level = down;
+        levelSince = now;
+        settling = true;
+      }
+    }
+
+    // Call once per loop. Costs two compares while the button is idle.
+    void tick() {
+      if ( !settling && ( state == IDLE ) ) {
+        return;
+      }
+      noInterrupts();
+      unsigned long now = millis();
+      settle(now);
+      // A press that is still settling may turn this into a double click, wait for it.
+      if ( !settling && ( state == RELEASED ) && ( now - releaseTime >= CLICK_MS ) ) {
+        push(BUTTON_CLICK);
+        state = IDLE;
+      }
+      interrupts();
+    }
+
+    // Take the oldest gesture from the queue, BUTTON_NONE when it is empty.
+    ButtonEvent getEvent() {
+      if ( head == tail ) {
+        return BUTTON_NONE;
+      }
+      ButtonEvent e = (ButtonEvent) events[head];
+      head = ( head + 1 ) & ( QUEUE_SIZE - 1 );
+      return e;
+    }
+};
+#endif
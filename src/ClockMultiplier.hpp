@@ -57,48 +57,48 @@ class ClockMultiplier {
 
   private:
     // General
-    const bool internalClock = false; // Refuses the triggers and starts the internal clock. Meant for developing / debugging.
-    const int internalClockBpm = 70; // The speed for the internal clock.
-    const int pushButtonDelay = 50; // The time the button will be insensitive after last change.
+    static constexpr bool internalClock = false; // Refuses the triggers and starts the internal clock. Meant for developing / debugging.
+    static constexpr int internalClockBpm = 70; // The speed for the internal clock.
+    static constexpr int pushButtonDelay = 50; // The time the button will be insensitive after last change.
 
 
     // Trigger IN
     int triggerInPin;
     int triggerInLEDPin;
 
-    long triggerInHigh; // Timestamp of the latest trigger high.
-    long triggerInLow; // Timestamp of the latest trigger low.
+    long triggerInHigh = 0; // Timestamp of the latest trigger high.
+    long triggerInLow = 0; // Timestamp of the latest trigger low.
 
     // Cycles
     long cycleStart = 0; // Timestamp of when the last cycle began.
-    int cycleTime = 0; // The absolute time span one cycle has in the given settings.
+    int16_t cycleTime = 0; // The absolute time span one cycle has in the given settings. 16 bits like int on the ATmega, it wraps after 32.7 s.
 
 
     // Quantity
     int quantityPotiPin;
     int quantityCVPin;
-    const int maxQuantity = 8; // The maximum amount of possible triggers out per cycle.
-    int currentQuantity; // The current amount of triggers per cycle.
+    static constexpr int maxQuantity = 8; // The maximum amount of possible triggers out per cycle.
+    int currentQuantity = 0; // The current amount of triggers per cycle.
 
 
     // Distribution
     int distributionPotiPin;
-    const int maxDistribution = 11; // The amount of different distribution patterns.
-    int currentDistribution;
+    static constexpr int maxDistribution = 11; // The amount of different distribution patterns.
+    int currentDistribution = 0;
 
 
     // Mute
-    int mutePinState; // 0 or 1.
-    unsigned long mutePinChangelog; // The timestamp of the last change on this button.
+    int mutePinState = 0; // 0 or 1.
+    unsigned long mutePinChangelog = 0; // The timestamp of the last change on this button.
 
     // Trigger OUT
     int triggerOutLEDPin;
-    const int TRIGGER_OUT_LED_MUTED_BRIGHTNESS = 1;      // The amount of brightness when muted.
-    const int TRIGGER_OUT_LED_NOT_MUTED_BRIGHTNESS = 50; // The amount of brightness when not muted.
-    const int TRIGGER_IN_LED_HIGH_BRIGHTNESS = 200;       // This led is red and needs some more umph.
+    static constexpr int TRIGGER_OUT_LED_MUTED_BRIGHTNESS = 1;      // The amount of brightness when muted.
+    static constexpr int TRIGGER_OUT_LED_NOT_MUTED_BRIGHTNESS = 50; // The amount of brightness when not muted.
+    static constexpr int TRIGGER_IN_LED_HIGH_BRIGHTNESS = 200;       // This led is red and needs some more umph.
     int triggerOutLEDBrightness = 0; // The brightness, which varies in different cases.
     int triggerOutPin;
-    const int triggerLength = 25; // In milliseconds.
+    static constexpr int triggerLength = 25; // In milliseconds.
     int triggerOut = LOW; // The state of the trigger out.
 
     // Read the trigger.
@@ -120,7 +120,7 @@ class ClockMultiplier {
       debug_print2("%d ", t);
       #ifdef DEBUG
         if ((cnt % 40) == 0) { 
-          debug_printf("\n");
+          debug_print("\n");
         }
         cnt++;
       #endif
@@ -203,7 +203,6 @@ class ClockMultiplier {
         currentQuantity = q;
         analogWrite(triggerInLEDPin, TRIGGER_IN_LED_HIGH_BRIGHTNESS); // A little flash to indicate the change.
         debug_print2("currentQuantity: %d\n", currentQuantity);
-        debug_print2("cvQuantity: %d\n", cvQuantity);
       }
 
       // ------------------------ DISTRIBUTION ------------------------
@@ -233,11 +232,11 @@ class ClockMultiplier {
       for (int i = 0; i < currentQuantity; i++ ) {
 
         // 1. Calculate the decimals from 0 to 1 for our hit quantity.
-        double d = (double) i * 1 / currentQuantity;
+        float d = (float) i * 1 / currentQuantity;
 
         // 2. Calculate the resulting factor depending on the set ease function.
         // Based on: https://easings.net/
-        double f;
+        float f;
 
         switch (currentDistribution) {
           case 1:
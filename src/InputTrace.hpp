@@ -0,0 +1,191 @@
+#ifndef _INPUT_TRACE
+#define _INPUT_TRACE
+
+/*
+ * Input trace recorder.
+ *
+ * When TRACE is defined in main.cpp, every change on the module's inputs
+ * (trigger in edges, the three poti/CV values, mode and mute state) is
+ * streamed over Serial as a compact binary record, timestamped in millis().
+ * Capture the stream into a file on the host and feed it to tools/replay to
+ * run both engines against a virtual clock (see README.md).
+ *
+ * Stream layout
+ *   header:  'C' 'M' 'R' 'T' <version> <seed:4> <start millis:4>   (little endian)
+ *   event:   <type:3 bits | delta:5 bits> [varint delta - 31] [payload]
+ *
+ * delta is the number of milliseconds since the previous event. Deltas of 31
+ * and up store 31 in the first byte and the remainder as a little endian
+ * base-128 varint. Payloads:
+ *   TRACE_TRIGGER_LOW, TRACE_TRIGGER_HIGH  none
+ *   TRACE_ANALOG                           <channel:2 bits | value bits 9..8> <value bits 7..0>
+ *   TRACE_STATE                            <bit 0: clock multiplier mode, bit 1: muted>
+ *   TRACE_DROPPED                          <varint: number of trigger in edges that were lost>
+ *
+ * Trigger in edges are queued with the time they were seen and written in
+ * order as the Serial transmit buffer has room, so a busy link delays them
+ * without changing their timestamps. Only when more than TRACE_PENDING_EDGES
+ * edges are waiting is an edge lost; the next TRACE_DROPPED record says how
+ * many. Mode, mute and analog values are read again on every pass and written
+ * when there is room, so a busy link delays them and may skip values in
+ * between, but the latest value always arrives.
+ */
+
+#include <stdint.h>
+
+const uint8_t TRACE_VERSION = 1;
+const uint8_t TRACE_HEADER_SIZE = 13;
+const uint8_t TRACE_MAX_RECORD_SIZE = 11; // Type byte, 5 byte delta varint and 5 byte payload.
+
+const uint8_t TRACE_TRIGGER_LOW = 0;
+const uint8_t TRACE_TRIGGER_HIGH = 1;
+const uint8_t TRACE_ANALOG = 2;
+const uint8_t TRACE_STATE = 3;
+const uint8_t TRACE_DROPPED = 4;
+
+const uint8_t TRACE_CHANNELS = 3;      // The number of analog inputs that are traced.
+const uint8_t TRACE_PENDING_EDGES = 8; // Trigger in edges that can wait for room in the Serial buffer.
+const uint8_t TRACE_SHORT_DELTA = 31;
+
+const uint8_t TRACE_STATE_CLOCK_MULTIPLIER = 0x01;
+const uint8_t TRACE_STATE_MUTED = 0x02;
+
+// Write v as little endian base-128 varint, return the number of bytes used.
+inline uint8_t traceEncodeVarint(uint8_t *buf, unsigned long v) {
+  uint8_t n = 0;
+  while ( v >= 0x80 ) {
+    buf[n++] = ( v & 0x7f ) | 0x80;
+    v >>= 7;
+  }
+  buf[n++] = v;
+  return n;
+}
+
+// Write the type and time delta of a record, return the number of bytes used.
+inline uint8_t traceEncodeEvent(uint8_t *buf, uint8_t type, unsigned long delta) {
+  if ( delta < TRACE_SHORT_DELTA ) {
+    buf[0] = ( type << 5 ) | delta;
+    return 1;
+  }
+  buf[0] = ( type << 5 ) | TRACE_SHORT_DELTA;
+  return 1 + traceEncodeVarint(buf + 1, delta - TRACE_SHORT_DELTA);
+}
+
+inline uint8_t traceEncodeHeader(uint8_t *buf, unsigned long seed, unsigned long start) {
+  buf[0] = 'C';
+  buf[1] = 'M';
+  buf[2] = 'R';
+  buf[3] = 'T';
+  buf[4] = TRACE_VERSION;
+  for (int i = 0; i < 4; i++) {
+    buf[5 + i] = ( seed >> ( 8 * i ) ) & 0xff;
+    buf[9 + i] = ( start >> ( 8 * i ) ) & 0xff;
+  }
+  return TRACE_HEADER_SIZE;
+}
+
+class InputTrace {
+
+  private:
+    int triggerInPin;
+    int analogPins[TRACE_CHANNELS];
+
+    unsigned long lastEvent = 0;        // Timestamp of the latest record written.
+    unsigned long lastAnalogSample = 0; // Timestamp of the latest analog scan, these are scanned once per millisecond.
+    int trigger = -1;                   // The latest trigger state seen, -1 when nothing has been seen yet.
+    int analogValues[TRACE_CHANNELS];   // The latest analog values written, -1 when nothing has been written yet.
+    int state = -1;                     // The latest mode and mute state written.
+    unsigned long lost = 0;             // The number of trigger in edges lost since the latest TRACE_DROPPED record.
+
+    // Trigger in edges waiting to be written, oldest first.
+    unsigned long pendingTime[TRACE_PENDING_EDGES];
+    uint8_t pendingLevel[TRACE_PENDING_EDGES];
+    uint8_t pendingFirst = 0;
+    uint8_t pendingCount = 0;
+
+    // Write a record if it fits in the Serial buffer.
+    bool emit(unsigned long now, uint8_t type, const uint8_t *payload, uint8_t payloadSize) {
+      uint8_t buf[TRACE_MAX_RECORD_SIZE];
+      uint8_t n = traceEncodeEvent(buf, type, now - lastEvent);
+      for (uint8_t i = 0; i < payloadSize; i++) {
+        buf[n++] = payload[i];
+      }
+      if ( Serial.availableForWrite() < n ) {
+        return false;
+      }
+      Serial.write(buf, n);
+      lastEvent = now;
+      return true;
+    }
+
+  public:
+
+    InputTrace(int _triggerInPin, int _analogPin0, int _analogPin1, int _analogPin2):
+               triggerInPin(_triggerInPin),
+               analogPins{_analogPin0, _analogPin1, _analogPin2},
+               analogValues{-1, -1, -1} {}
+
+    // Write the header. Serial must have been started.
+    void begin(unsigned long seed) {
+      uint8_t buf[TRACE_HEADER_SIZE];
+      lastEvent = millis();
+      Serial.write(buf, traceEncodeHeader(buf, seed, lastEvent));
+    }
+
+    // Scan the inputs and write a record for everything that changed. Call this once per loop.
+    void sample(bool inClockMultiplierMode, bool inMutedState) {
+      unsigned long now = millis();
+
+      // Queue a trigger in edge with its own timestamp.
+      int t = digitalRead(triggerInPin);
+      if ( t != trigger ) {
+        trigger = t;
+        if ( pendingCount < TRACE_PENDING_EDGES ) {
+          uint8_t i = ( pendingFirst + pendingCount ) % TRACE_PENDING_EDGES;
+          pendingTime[i] = now;
+          pendingLevel[i] = t;
+          pendingCount++;
+        } else {
+          lost++;
+        }
+      }
+
+      // Write the queued edges. Records go out in time order, so nothing else is written until they are all out.
+      while ( pendingCount > 0 ) {
+        if ( !emit(pendingTime[pendingFirst], pendingLevel[pendingFirst] ? TRACE_TRIGGER_HIGH : TRACE_TRIGGER_LOW, 0, 0) ) {
+          return;
+        }
+        pendingFirst = ( pendingFirst + 1 ) % TRACE_PENDING_EDGES;
+        pendingCount--;
+      }
+
+      if ( lost > 0 ) {
+        uint8_t payload[5];
+        if ( emit(now, TRACE_DROPPED, payload, traceEncodeVarint(payload, lost)) ) {
+          lost = 0;
+        }
+      }
+
+      int s = ( inClockMultiplierMode ? TRACE_STATE_CLOCK_MULTIPLIER : 0 ) | ( inMutedState ? TRACE_STATE_MUTED : 0 );
+      if ( s != state ) {
+        uint8_t payload[1] = { (uint8_t) s };
+        if ( emit(now, TRACE_STATE, payload, 1) ) {
+          state = s;
+        }
+      }
+
+      if ( ( now != lastAnalogSample ) || ( analogValues[0] < 0 ) ) {
+        lastAnalogSample = now;
+        for (uint8_t ch = 0; ch < TRACE_CHANNELS; ch++) {
+          int v = analogRead(analogPins[ch]);
+          if ( v != analogValues[ch] ) {
+            uint8_t payload[2] = { (uint8_t) ( ( ch << 2 ) | ( v >> 8 ) ), (uint8_t) ( v & 0xff ) };
+            if ( emit(now, TRACE_ANALOG, payload, 2) ) {
+              analogValues[ch] = v;
+            }
+          }
+        }
+      }
+    }
+};
+#endif
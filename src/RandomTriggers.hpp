@@ -48,8 +48,8 @@ class RandomTriggers {
   private:
 
     // General
-    const bool internalClock = true; // Refuses the triggers and starts the internal clock. Meant for developing / debugging.
-    const int internalClockBpm = 480; // The speed for the internal clock.
+    static constexpr bool internalClock = false; // Refuses the triggers and starts the internal clock. Meant for developing / debugging.
+    static constexpr int internalClockBpm = 480; // The speed for the internal clock.
 
 
     // Trigger IN
@@ -59,28 +59,31 @@ class RandomTriggers {
 
 
     // Pattern
-    int patternLength;  // Variable sequence length from 8 to 128
-    int patternDensity;
+    int patternLength = 0;  // Variable sequence length from 8 to 128
+    int patternDensity = 0;
     int densityPotiPin;
     int lengthPotiPin;
-    String pattern; // The current pattern stored in zeros (0 = no trigger) and ones (1 = trigger).
-    unsigned long calculation; // Timestamp of the latest calculation.
-    unsigned int calcIndication = 200; // Time in milliseconds that the LEDs are lit to indicate the recent calculation.
+    static constexpr int maxPatternLength = 128;
+    uint8_t pattern[maxPatternLength / 8]; // The current pattern, one bit per step (0 = no trigger, 1 = trigger).
+    unsigned long calculation = 0; // Timestamp of the latest calculation.
+    static constexpr unsigned int calcIndication = 200; // Time in milliseconds that the LEDs are lit to indicate the recent calculation.
+    unsigned long seed = 0; // The seed given to randomSeed(), logged by the input trace.
 
 
     // Trigger OUT
     int patternPosition = 1; // Starts at 1 and ends at patternLength.
-    const int triggerLength = 25; // In milliseconds.
+    static constexpr int triggerLength = 25; // In milliseconds.
     int triggerOutLEDPin;
-    unsigned long triggerOutHigh; // Timestamp of the latest trigger out.
+    unsigned long triggerOutHigh = 0; // Timestamp of the latest trigger out.
     int triggerOutPin;
-    const int TRIGGER_OUT_LED_LOW_BRIGHTNESS = 0;
-    const int TRIGGER_OUT_LED_HIGH_BRIGHTNESS = 50;
+    static constexpr int TRIGGER_OUT_LED_LOW_BRIGHTNESS = 0;
+    static constexpr int TRIGGER_OUT_LED_HIGH_BRIGHTNESS = 50;
 
     void init() {
       // Ensuring non-repeating randomness in random().
       // See https://www.arduino.cc/reference/en/language/functions/random-numbers/randomseed/
-      randomSeed(analogRead(0));
+      seed = analogRead(0);
+      randomSeed(seed);
     }
 
     // Read the trigger.
@@ -138,22 +141,24 @@ class RandomTriggers {
     }
 
     // Calculate the pattern based on the current config.
-    String calculatePattern( int l , int d ){
-      String p; // The pattern to be stored.
-
+    void calculatePattern( int l , int d ){
       // Iteratively create the pattern.
       for (int i = 0; i < l; i++) {
         // Random binary with propability
         // As seen on: https://forum.arduino.cc/t/increasing-probability-with-a-number/358459/6
         if ( random( 100 ) < d ) {
           // will be executed d % of time
-          p = p + "1";
+          pattern[i >> 3] |= ( 1 << ( i & 7 ) );
         } else {
           // will be executed in ( 100 – d ) % of the time
-          p = p + "0";
+          pattern[i >> 3] &= ~( 1 << ( i & 7 ) );
         }
       }      
-      return p;
+    }
+
+    // Is there a trigger on step i (counting from 0) of the pattern?
+    bool isTrigger( int i ){
+      return pattern[i >> 3] & ( 1 << ( i & 7 ) );
     }
 
     public:
@@ -175,6 +180,10 @@ class RandomTriggers {
           init();
         }
 
+      unsigned long getSeed() {
+        return seed;
+      }
+
       void tick() {
         // --------------------- CALCULATE PATTERN --------------------
         int l = getLength();  // The length of the pattern (sequence).
@@ -196,7 +205,7 @@ class RandomTriggers {
         // Did the pattern config change?
         // Density
         if ( d != patternDensity ) {          
-          debug_print2("Pattern density: %d%\n", d);
+          debug_print2("Pattern density: %d%%\n", d);
           // Set the new density globally.
           patternDensity = d;
           // Ping the calculation.
@@ -205,15 +214,18 @@ class RandomTriggers {
 
         // Re-calculate pattern and reset position if needed .
         if ( c == true ) {
-          String p = calculatePattern( patternLength , patternDensity );
-
-          // Set the global pattern accordingly.
-          pattern = p;
+          calculatePattern( patternLength , patternDensity );
 
           // Store the timestamp of the calculation.
           calculation = millis();
             
-          debug_print2("Pattern: %s\n", p.c_str());
+          #ifdef DEBUG
+            printf("Pattern: ");
+            for (int i = 0; i < patternLength; i++) {
+              printf("%d", isTrigger(i));
+            }
+            printf("\n");
+          #endif
 
           // Reset global pattern position.
           patternPosition = 1;         
@@ -239,7 +251,7 @@ class RandomTriggers {
             debug_print("Trigger IN\n");
 
             // Do we have a trigger on the current pattern position?
-            if ( pattern.substring( ( patternPosition - 1 ) ).startsWith( "1" ) ) { // YES !
+            if ( isTrigger( patternPosition - 1 ) ) { // YES !
               // Log the trigger out.
               triggerOutHigh = millis();
               debug_print2("Trigger OUT: patternPosition: %d\n", patternPosition);
@@ -0,0 +1,56 @@
+#ifndef _STACK_MONITOR
+#define _STACK_MONITOR
+
+/*
+ * Stack painting monitor.
+ *
+ * Before anything else runs, all RAM between the end of the static data
+ * (_end) and the top of the stack (__stack) is filled with a canary byte.
+ * Everything is allocated statically, there is no heap, so whatever is
+ * found overwritten later has been used by the stack. stackPeak() tells
+ * how deep the stack has been at most, stackFree() how much of the
+ * painted area has never been touched.
+ *
+ * Include this in main.cpp only, it places code in the .init1 section.
+ */
+
+#include <stdint.h>
+
+extern uint8_t _end;
+extern uint8_t __stack;
+
+const uint8_t STACK_CANARY = 0xc5;
+
+// Runs from .init1, before the C runtime is set up, so no C and no stack here.
+void paintStack() __attribute__ ((naked, used, section (".init1")));
+
+void paintStack() {
+  __asm volatile ("    ldi r30, lo8(_end)\n"
+                  "    ldi r31, hi8(_end)\n"
+                  "    ldi r24, %0\n"
+                  "    ldi r25, hi8(__stack)\n"
+                  "    rjmp 2f\n"
+                  "1:  st Z+, r24\n"
+                  "2:  cpi r30, lo8(__stack)\n"
+                  "    cpc r31, r25\n"
+                  "    brlo 1b\n"
+                  "    breq 1b\n" :: "M" (STACK_CANARY));
+}
+
+// The number of bytes between the static data and the stack that have never been written.
+uint16_t stackFree() {
+  const uint8_t *p = &_end;
+  uint16_t c = 0;
+  while ( ( p <= &__stack ) && ( *p == STACK_CANARY ) ) {
+    p++;
+    c++;
+  }
+  return c;
+}
+
+// The deepest the stack has been since reset, in bytes.
+uint16_t stackPeak() {
+  return ( &__stack - &_end + 1 ) - stackFree();
+}
+
+#endif
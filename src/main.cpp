@@ -14,12 +14,19 @@
 
 #include <Arduino.h>
 
-#include "OneButton.h"
-
-//#define DEBUG // Enables the Serial print in several functions. Slows down the frontend.
+// Build options, each one is set by its own build environment in platformio.ini:
+// DEBUG          pio run -e nanoatmega328_debug. Enables the Serial print in several functions. Slows down the frontend.
+//                printf() comes from LibPrintf, which only this environment pulls in.
+// TRACE          pio run -e nanoatmega328_trace. Streams all input changes over Serial for offline replay (see tools/replay).
+// STACK_MONITOR  pio run -e nanoatmega328_stack. Reports the peak stack depth over Serial once per second.
+
+#if defined(TRACE) && ( defined(DEBUG) || defined(STACK_MONITOR) )
+  #error "TRACE streams binary data over the serial port, it cannot be combined with DEBUG or STACK_MONITOR."
+#endif
 
 #ifdef DEBUG
-  #define debug_begin(x) serial_begin(x)
+  #include <LibPrintf.h>
+  #define debug_begin(x) Serial.begin(x)
   #define debug_print(x) printf(x)
   #define debug_print2(x, y) printf(x, y)
   #define debug_print3(x, y, z) printf(x, y, z)
@@ -32,28 +39,35 @@
 
 #include "ClockMultiplier.hpp"
 #include "RandomTriggers.hpp"
+#include "Button.hpp"
+#ifdef TRACE
+  #include "InputTrace.hpp"
+#endif
+#ifdef STACK_MONITOR
+  #include "StackMonitor.hpp"
+#endif
 
 const bool CLOCK_MULTIPLIER = true;
 const bool RANDOM_TRIGGER = false;
 
 bool inClockMultiplierMode = CLOCK_MULTIPLIER;
-int triggerInPin = A5;
-int triggerInLEDPin = 3; 
-int quantityPotiPin = A3;
-int quantityCVPin = A4;
-int distributionPotiPin = A2;
-int toggleAndMutePin = 2;
-int triggerOutLEDPin = 5;
-int triggerOutPin = 6;
-int modeClockMultiplierLedPin = 10; // D10 pwm capable pin for indicating Clock Multiplier mode.
-int modeRandomTriggerLedPin = 9;    // D9  pwm capable pin for indicating Random Trigger mode.
+const int triggerInPin = A5;
+const int triggerInLEDPin = 3; 
+const int quantityPotiPin = A3;
+const int quantityCVPin = A4;
+const int distributionPotiPin = A2;
+const int toggleAndMutePin = 2;
+const int triggerOutLEDPin = 5;
+const int triggerOutPin = 6;
+const int modeClockMultiplierLedPin = 10; // D10 pwm capable pin for indicating Clock Multiplier mode.
+const int modeRandomTriggerLedPin = 9;    // D9  pwm capable pin for indicating Random Trigger mode.
 
 // Note all outputs (3, 5, 9, 10) chosen to connect LEDs to are PWM capable!
 
 const int MODE_LED_HIGH_BRIGHTNESS = 150;
 
-int densitiyPotiPin = A2;
-int lengthPotiPin = A3;
+const int densitiyPotiPin = A2;
+const int lengthPotiPin = A3;
 
 ClockMultiplier clockMultiplier = 
   ClockMultiplier(triggerInPin, 
@@ -73,9 +87,21 @@ RandomTriggers randomTriggers =
                  triggerOutLEDPin, 
                  triggerOutPin);
 
+#ifdef TRACE
+InputTrace inputTrace = 
+  InputTrace(triggerInPin, 
+             distributionPotiPin, 
+             quantityPotiPin, 
+             quantityCVPin);
+#endif
+
 bool inMutedState = false;
 
-OneButton button(toggleAndMutePin, false);
+Button button(toggleAndMutePin, true);
+
+void buttonInterrupt() {
+  button.handleInterrupt();
+}
 
 // When the button was pressed 1 time we toggle the mute state, this is for the Clock Multiplier only.
 void myClickFunction() {
@@ -100,26 +126,49 @@ void myDoubleClickFunction() {
   updateModeLeds();
 }
 
-// This function will be called when the button is released.
-void LongPressStop(void *oneButton) {
+// This function will be called when the button is released after a long press.
+void LongPressStop() {
     inClockMultiplierMode = !inClockMultiplierMode;
     updateModeLeds();
 }
 
+#ifdef DEBUG
+// Print the mode whenever it changes.
+void showMode() {
+  static int lastMode = -1;
+  if (inClockMultiplierMode != lastMode) {
+    lastMode = inClockMultiplierMode;
+    printf("Mode: %s\n", inClockMultiplierMode ? "Clock Multiplier" : "Random Trigger");
+  }
+}
+#endif
+
+#ifdef STACK_MONITOR
+// Print the peak stack depth once per second.
+void showStack() {
+  static unsigned long lastReport = 0;
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    Serial.print(F("stack peak: "));
+    Serial.print(stackPeak());
+    Serial.print(F(" bytes, never used: "));
+    Serial.println(stackFree());
+    #ifdef STACK_RESERVE
+      if (stackPeak() > STACK_RESERVE) {
+        Serial.println(F("stack peak exceeds STACK_RESERVE"));
+      }
+    #endif
+  }
+}
+#endif
+
 void setup() {
-  debug_begin(230400); // Initialize serial communication at 9600 bits per second.
+  debug_begin(230400); // Initialize serial communication at 230400 bits per second.
   pinMode(modeClockMultiplierLedPin, OUTPUT);
   pinMode(modeRandomTriggerLedPin, OUTPUT);
   
-  // Link the myClickFunction function to be called on a click event.
-  button.attachClick(myClickFunction);
-
-  // Link the doubleclick function to be called on a doubleclick event.
-  button.attachDoubleClick(myDoubleClickFunction);  
-
-  // link functions to be called on events.
-  button.attachLongPressStop(LongPressStop, &button);
-  button.setLongPressIntervalMs(1000);
+  // The button pin (D2) triggers INT0, the gestures are handed out in loop().
+  button.begin(buttonInterrupt);
 
   // Pin settings for Clock Multiplier and Random Trigger.
   pinMode(triggerInPin, INPUT);
@@ -129,6 +178,14 @@ void setup() {
   pinMode(distributionPotiPin, INPUT);
   pinMode(triggerOutLEDPin, OUTPUT);
   pinMode(triggerOutPin, OUTPUT);
+
+  #ifdef TRACE
+    Serial.begin(230400);
+    inputTrace.begin(randomTriggers.getSeed());
+  #endif
+  #if defined(STACK_MONITOR) && !defined(DEBUG)
+    Serial.begin(230400);
+  #endif
 }
 
 void loop() {
@@ -140,10 +197,29 @@ void loop() {
     only_once = false;
     updateModeLeds();
   }
+  #ifdef TRACE
+    inputTrace.sample(inClockMultiplierMode, inMutedState);
+  #endif
+  #ifdef STACK_MONITOR
+    showStack();
+  #endif
   if (inClockMultiplierMode == CLOCK_MULTIPLIER) {
     clockMultiplier.tick(inMutedState);
   } else {
    randomTriggers.tick();
   }
   button.tick();
+  switch (button.getEvent()) {
+    case BUTTON_CLICK:
+      myClickFunction();
+      break;
+    case BUTTON_DOUBLE_CLICK:
+      myDoubleClickFunction();
+      break;
+    case BUTTON_LONG_PRESS_STOP:
+      LongPressStop();
+      break;
+    default:
+      break;
+  }
 }
\ No newline at end of file
@@ -0,0 +1,444 @@
+/*
+  Timing accuracy benchmark for both engines.
+
+  Drives the engines from src/ with a synthetic steady clock over a sweep of
+  tempos, settings and loop pass durations and measures where the trigger out
+  edges land:
+
+    clock   ClockMultiplier, one row per tempo, distribution and pass (all quantities).
+            The error of an edge is its distance to the ideal position
+            cycleStart + cycleTime * ease(i / quantity).
+    random  RandomTriggers, one row per tempo, pattern length and pass (densities 0..99%).
+            The error of an edge is its latency to the trigger in edge it answers;
+            the expected pattern is recomputed from the seed.
+
+  The pass column is the duration of one loop() pass in microseconds; 1000 is
+  one pass per millisecond, the longer ones stand for a loop slowed down by
+  other work and show how much timing that costs.
+
+  Per row: the number of expected edges, mean / p99 / max edge error in ms,
+  missed and double (or spurious) triggers, mean and max pulse width error in ms.
+
+  Usage: bench [--baseline file] [--write-baseline file] [--cycles n] [--pulse ms]
+
+    --baseline        Compare against a stored run, exit 1 when a row is worse than the tolerances below.
+    --write-baseline  Store this run.
+    --cycles          Input cycles measured per setting, default 32.
+    --pulse           Width of the trigger in pulses in ms, default 10.
+*/
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "Module.hpp"
+
+// Allowed degradation against the baseline.
+const double TOLERANCE_MEAN = 0.25;  // ms
+const double TOLERANCE_P99 = 1.0;    // ms
+const double TOLERANCE_MAX = 1.0;    // ms
+const int TOLERANCE_MISSED = 0;
+const int TOLERANCE_DOUBLE = 0;
+const double TOLERANCE_WIDTH = 1.0;  // ms, on the maximum pulse width error
+
+const int TEMPOS[] = { 30, 60, 90, 120, 180, 240, 300, 400, 500, 600 };
+const int DENSITIES[] = { 0, 10, 25, 50, 75, 90, 99 };
+const int LENGTHS[] = { 4, 8, 16, 32, 64, 128 };
+const int PASSES[] = { 1000, 2000, 5000, 10000 }; // Loop pass durations in us.
+const int MAX_QUANTITY = 8;
+const int MAX_DISTRIBUTION = 11;
+const int TRIGGER_LENGTH = 25;       // The trigger out length of both engines in ms.
+const unsigned long START = 1000;    // millis() at the first tick.
+const unsigned long LEAD_IN = 500;   // Time before the first trigger in, covers the pattern calculation indication.
+const int WARMUP_CYCLES = 2;         // Input cycles before measuring, ClockMultiplier needs one to learn the cycle time.
+const unsigned long SEED = 12345;
+
+struct Row {
+  std::string engine;
+  int bpm;
+  int setting;
+  int pass;
+  int edges = 0;
+  double mean = 0;
+  double p99 = 0;
+  double max = 0;
+  int missed = 0;
+  int doubles = 0;
+  double widthMean = 0;
+  double widthMax = 0;
+
+  std::string key() const {
+    return engine + " " + std::to_string(bpm) + " " + std::to_string(setting) + " " + std::to_string(pass);
+  }
+};
+
+// Collects edge and pulse width errors for one row.
+struct Stats {
+  std::vector<double> errors;
+  std::vector<double> widthErrors;
+  int expected = 0;
+  int missed = 0;
+  int doubles = 0;
+
+  void fill(Row &row) {
+    row.edges = expected;
+    row.missed = missed;
+    row.doubles = doubles;
+    if ( !errors.empty() ) {
+      std::sort(errors.begin(), errors.end());
+      double sum = 0;
+      for (double e : errors) {
+        sum += e;
+      }
+      row.mean = sum / errors.size();
+      row.p99 = errors[std::min(errors.size() - 1, (size_t) ceil(0.99 * errors.size()) - 1)];
+      row.max = errors.back();
+    }
+    if ( !widthErrors.empty() ) {
+      double sum = 0;
+      for (double e : widthErrors) {
+        sum += e;
+        row.widthMax = std::max(row.widthMax, e);
+      }
+      row.widthMean = sum / widthErrors.size();
+    }
+  }
+};
+
+struct Pulse {
+  unsigned long rise;
+  unsigned long width;
+};
+
+// The middle of the poti range that map(x, 0, 1024, outMin, outMax) turns into target, -1 if there is none.
+static int potFor(long outMin, long outMax, long target) {
+  int first = -1;
+  int last = -1;
+  for (int x = 0; x < 1024; x++) {
+    if ( map(x, 0, 1024, outMin, outMax) == target ) {
+      if ( first < 0 ) {
+        first = x;
+      }
+      last = x;
+    }
+  }
+  return first < 0 ? -1 : ( first + last ) / 2;
+}
+
+// The ease functions of ClockMultiplier in full precision.
+static double ease(int distribution, double d) {
+  switch (distribution) {
+    case 1: return pow(d, 5);
+    case 2: return pow(d, 4);
+    case 3: return pow(d, 3);
+    case 4: return d * d;
+    case 5: return 1 - cos(( d * M_PI ) / 2);
+    case 7: return sin(( d * M_PI ) / 2);
+    case 8: return 1 - ( 1 - d ) * ( 1 - d );
+    case 9: return 1 - pow(1 - d, 3);
+    case 10: return 1 - pow(1 - d, 4);
+    case 11: return 1 - pow(1 - d, 5);
+    default: return d;
+  }
+}
+
+// A steady clock at bpm for cycles input cycles. rises receives the ideal (unrounded) rising edge times.
+static Trace clockTrace(int bpm, int cycles, int pulse, const int pots[TRACE_CHANNELS], std::vector<double> &rises) {
+  Trace trace;
+  trace.seed = SEED;
+  trace.start = START;
+  for (uint8_t ch = 0; ch < TRACE_CHANNELS; ch++) {
+    trace.events.push_back({ START, TRACE_ANALOG, ch, (unsigned long) pots[ch] });
+  }
+  trace.events.push_back({ START, TRACE_STATE, 0, TRACE_STATE_CLOCK_MULTIPLIER });
+  double period = 60000.0 / bpm;
+  rises.clear();
+  for (int k = 0; k <= cycles; k++) {
+    double rise = START + LEAD_IN + k * period;
+    unsigned long t = lround(rise);
+    rises.push_back(rise);
+    trace.events.push_back({ t, TRACE_TRIGGER_HIGH, 0, HIGH });
+    trace.events.push_back({ t + pulse, TRACE_TRIGGER_LOW, 0, LOW });
+  }
+  return trace;
+}
+
+static std::vector<Pulse> run(Module &module, const Trace &trace, int pass, unsigned long tail) {
+  std::vector<Pulse> pulses;
+  module.run(trace, pass, tail, [&](unsigned long t, bool level) {
+    if ( level ) {
+      pulses.push_back({ t, 0 });
+    } else if ( !pulses.empty() ) {
+      pulses.back().width = t - pulses.back().rise;
+    }
+  });
+  // A trigger out that never falls again counts until the end of the run.
+  if ( !pulses.empty() && module.triggerOut() ) {
+    pulses.back().width = trace.end() + tail - pulses.back().rise;
+  }
+  return pulses;
+}
+
+static Row benchClock(int bpm, int distribution, int pass, int cycles, int pulse) {
+  Row row;
+  row.engine = "clock";
+  row.bpm = bpm;
+  row.setting = distribution;
+  row.pass = pass;
+  Stats stats;
+  for (int quantity = 1; quantity <= MAX_QUANTITY; quantity++) {
+    int pots[TRACE_CHANNELS] = { potFor(1, MAX_DISTRIBUTION + 1, distribution), potFor(1, MAX_QUANTITY + 1, quantity), 0 };
+    std::vector<double> rises;
+    Trace trace = clockTrace(bpm, WARMUP_CYCLES + cycles, pulse, pots, rises);
+    Module module(trace.seed, trace.start, Module::CLOCK_MULTIPLIER);
+    std::vector<Pulse> pulses = run(module, trace, pass, 0);
+
+    // The ideal edges of the measured cycles, in time order.
+    std::vector<double> ideal;
+    double period = 60000.0 / bpm;
+    for (int k = WARMUP_CYCLES; k < WARMUP_CYCLES + cycles; k++) {
+      for (int i = 0; i < quantity; i++) {
+        ideal.push_back(rises[k] + period * ease(distribution, (double) i / quantity));
+      }
+    }
+    double from = rises[WARMUP_CYCLES];
+    double to = rises[WARMUP_CYCLES + cycles];
+
+    // Every actual edge belongs to the nearest ideal edge.
+    std::vector<int> hits(ideal.size(), 0);
+    for (const Pulse &p : pulses) {
+      if ( p.rise + p.width > from && p.rise < to && p.width > 0 ) {
+        stats.widthErrors.push_back(fabs((double) p.width - TRIGGER_LENGTH));
+      }
+      if ( p.rise < from - 0.5 || p.rise >= to - 0.5 ) {
+        continue;
+      }
+      auto it = std::lower_bound(ideal.begin(), ideal.end(), (double) p.rise);
+      size_t n = it - ideal.begin();
+      if ( n == ideal.size() || ( n > 0 && p.rise - ideal[n - 1] < ideal[n] - p.rise ) ) {
+        n--;
+      }
+      if ( hits[n]++ == 0 ) {
+        stats.errors.push_back(fabs(p.rise - ideal[n]));
+      }
+    }
+    stats.expected += ideal.size();
+    for (int h : hits) {
+      if ( h == 0 ) {
+        stats.missed++;
+      } else {
+        stats.doubles += h - 1;
+      }
+    }
+  }
+  stats.fill(row);
+  return row;
+}
+
+static Row benchRandom(int bpm, int length, int lengthPot, int pass, int cycles, int pulse) {
+  Row row;
+  row.engine = "random";
+  row.bpm = bpm;
+  row.setting = length;
+  row.pass = pass;
+  Stats stats;
+  for (int density : DENSITIES) {
+    int densityPot = potFor(0, 100, density);
+    int pots[TRACE_CHANNELS] = { densityPot, lengthPot, 0 };
+    std::vector<double> rises;
+    Trace trace = clockTrace(bpm, WARMUP_CYCLES + cycles, pulse, pots, rises);
+    Module module(trace.seed, trace.start, Module::RANDOM_TRIGGERS);
+
+    // The pattern RandomTriggers will calculate on its first tick.
+    uint32_t state = host::randomState;
+    std::vector<bool> pattern;
+    for (int i = 0; i < length; i++) {
+      pattern.push_back(random(100) < map(densityPot, 0, 1024, 0, 100));
+    }
+    host::randomState = state;
+
+    std::vector<Pulse> pulses = run(module, trace, pass, 0);
+
+    // Every actual edge answers the latest trigger in edge before it.
+    std::vector<unsigned long> inputs;
+    for (double r : rises) {
+      inputs.push_back(lround(r));
+    }
+    std::vector<int> hits(inputs.size(), 0);
+    for (const Pulse &p : pulses) {
+      auto it = std::upper_bound(inputs.begin(), inputs.end(), p.rise);
+      if ( it == inputs.begin() ) {
+        continue;
+      }
+      size_t k = it - inputs.begin() - 1;
+      if ( k < (size_t) WARMUP_CYCLES || k >= (size_t) ( WARMUP_CYCLES + cycles ) ) {
+        continue;
+      }
+      if ( hits[k]++ == 0 ) {
+        stats.errors.push_back(p.rise - rises[k] < 0 ? 0 : p.rise - rises[k]);
+      }
+      if ( p.width > 0 ) {
+        stats.widthErrors.push_back(fabs((double) p.width - TRIGGER_LENGTH));
+      }
+    }
+    for (int k = WARMUP_CYCLES; k < WARMUP_CYCLES + cycles; k++) {
+      bool expected = pattern[k % length];
+      stats.expected += expected;
+      if ( expected && hits[k] == 0 ) {
+        stats.missed++;
+      }
+      if ( hits[k] > (int) expected ) {
+        stats.doubles += hits[k] - expected;
+      }
+    }
+  }
+  stats.fill(row);
+  return row;
+}
+
+static const char *HEADER = "# engine bpm setting pass edges mean p99 max missed double width_mean width_max";
+
+static void printRow(FILE *f, const Row &r) {
+  fprintf(f, "%-6s %3d %3d %5d %5d %6.2f %6.2f %6.2f %4d %4d %6.2f %6.2f\n",
+          r.engine.c_str(), r.bpm, r.setting, r.pass, r.edges, r.mean, r.p99, r.max,
+          r.missed, r.doubles, r.widthMean, r.widthMax);
+}
+
+static bool loadBaseline(const char *path, std::map<std::string, Row> &rows) {
+  FILE *f = fopen(path, "r");
+  if ( !f ) {
+    return false;
+  }
+  char line[256];
+  while ( fgets(line, sizeof(line), f) ) {
+    if ( line[0] == '#' ) {
+      continue;
+    }
+    char engine[16];
+    Row r;
+    if ( sscanf(line, "%15s %d %d %d %d %lf %lf %lf %d %d %lf %lf", engine, &r.bpm, &r.setting, &r.pass, &r.edges,
+                &r.mean, &r.p99, &r.max, &r.missed, &r.doubles, &r.widthMean, &r.widthMax) == 12 ) {
+      r.engine = engine;
+      rows[r.key()] = r;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+// Print what got worse than the tolerances allow, return the number of failures.
+static int compare(const Row &r, const Row &b) {
+  int failures = 0;
+  auto check = [&](const char *name, double value, double base, double tolerance) {
+    if ( value > base + tolerance + 1e-9 ) {
+      printf("FAIL %s: %s %.2f, baseline %.2f\n", r.key().c_str(), name, value, base);
+      failures++;
+    }
+  };
+  check("mean", r.mean, b.mean, TOLERANCE_MEAN);
+  check("p99", r.p99, b.p99, TOLERANCE_P99);
+  check("max", r.max, b.max, TOLERANCE_MAX);
+  check("missed", r.missed, b.missed, TOLERANCE_MISSED);
+  check("double", r.doubles, b.doubles, TOLERANCE_DOUBLE);
+  check("width_max", r.widthMax, b.widthMax, TOLERANCE_WIDTH);
+  return failures;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: bench [--baseline file] [--write-baseline file] [--cycles n] [--pulse ms]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *baselinePath = 0;
+  const char *writePath = 0;
+  int cycles = 32;
+  int pulse = 10;
+
+  for (int i = 1; i < argc; i++) {
+    if ( !strcmp(argv[i], "--baseline") && i + 1 < argc ) {
+      baselinePath = argv[++i];
+    } else if ( !strcmp(argv[i], "--write-baseline") && i + 1 < argc ) {
+      writePath = argv[++i];
+    } else if ( !strcmp(argv[i], "--cycles") && i + 1 < argc ) {
+      cycles = atoi(argv[++i]);
+    } else if ( !strcmp(argv[i], "--pulse") && i + 1 < argc ) {
+      pulse = atoi(argv[++i]);
+    } else {
+      usage();
+    }
+  }
+  if ( cycles < 1 || pulse < 1 ) {
+    usage();
+  }
+
+  std::vector<Row> rows;
+  std::vector<std::string> notes;
+  for (int bpm : TEMPOS) {
+    for (int distribution = 1; distribution <= MAX_DISTRIBUTION; distribution++) {
+      for (int pass : PASSES) {
+        rows.push_back(benchClock(bpm, distribution, pass, cycles, pulse));
+      }
+    }
+  }
+  for (int v = 1; v <= 6; v++) {
+    int lengthPot = potFor(1, 6, v);
+    if ( lengthPot < 0 ) {
+      notes.push_back("# random: pattern length " + std::to_string(LENGTHS[v - 1]) + " cannot be set with the length poti");
+      continue;
+    }
+    for (int bpm : TEMPOS) {
+      for (int pass : PASSES) {
+        rows.push_back(benchRandom(bpm, LENGTHS[v - 1], lengthPot, pass, cycles, pulse));
+      }
+    }
+  }
+
+  printf("%s\n", HEADER);
+  for (const Row &r : rows) {
+    printRow(stdout, r);
+  }
+  for (const std::string &n : notes) {
+    printf("%s\n", n.c_str());
+  }
+
+  if ( writePath ) {
+    FILE *f = fopen(writePath, "w");
+    if ( !f ) {
+      fprintf(stderr, "bench: cannot write %s\n", writePath);
+      return 1;
+    }
+    fprintf(f, "# Timing benchmark baseline, written by tools/bin/bench --write-baseline.\n");
+    fprintf(f, "# cycles %d, trigger in pulse %d ms\n", cycles, pulse);
+    fprintf(f, "%s\n", HEADER);
+    for (const Row &r : rows) {
+      printRow(f, r);
+    }
+    fclose(f);
+  }
+
+  if ( baselinePath ) {
+    std::map<std::string, Row> baseline;
+    if ( !loadBaseline(baselinePath, baseline) ) {
+      fprintf(stderr, "bench: cannot read %s\n", baselinePath);
+      return 1;
+    }
+    int failures = 0;
+    for (const Row &r : rows) {
+      auto it = baseline.find(r.key());
+      if ( it == baseline.end() ) {
+        printf("NEW  %s: not in the baseline\n", r.key().c_str());
+        continue;
+      }
+      failures += compare(r, it->second);
+    }
+    printf("%s: %d of %zu rows worse than the baseline\n", failures ? "FAILED" : "PASSED", failures, rows.size());
+    return failures ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef _HOST_CHECK
+#define _HOST_CHECK
+
+/*
+ * Minimal assertions for the host checks in tools/check. A failed CHECK prints
+ * where and why and makes checkResult() return 1.
+ */
+
+#include <stdio.h>
+
+inline int checkFailures = 0;
+inline int checkCount = 0;
+
+#define CHECK(cond) \
+  do { \
+    checkCount++; \
+    if ( !( cond ) ) { \
+      checkFailures++; \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+inline int checkResult(const char *name) {
+  printf("%s: %d of %d checks passed\n", name, checkCount - checkFailures, checkCount);
+  return checkFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+  Host check for the gesture recognition in src/Button.hpp: scripted pin
+  changes go through the pin change interrupt, tick() runs once per pass and
+  the gestures that come out of getEvent() are compared with what OneButton
+  would have reported.
+*/
+
+#include <vector>
+
+#include "Arduino.h"
+#include "Button.hpp"
+#include "Check.hpp"
+
+const uint8_t BUTTON_PIN = 2;
+
+struct Change {
+  unsigned long time;
+  int level;
+};
+
+struct Gesture {
+  unsigned long time;
+  ButtonEvent event;
+};
+
+static Button *button = 0;
+
+static void buttonInterrupt() {
+  button->handleInterrupt();
+}
+
+// Play the pin changes from 1000 ms on with a loop pass every tickEvery ms, return the gestures with the time they came out.
+static std::vector<Gesture> play(const std::vector<Change> &changes, unsigned long tickEvery = 1, unsigned long until = 5000) {
+  host::reset();
+  Button b(BUTTON_PIN, true);
+  button = &b;
+  b.begin(buttonInterrupt);
+
+  std::vector<Gesture> gestures;
+  size_t next = 0;
+  for (unsigned long t = 1000; t <= until; t++) {
+    host::now = t;
+    while ( next < changes.size() && changes[next].time == t ) {
+      host::inputs[BUTTON_PIN] = changes[next++].level;
+      host::isrs[digitalPinToInterrupt(BUTTON_PIN)]();
+    }
+    if ( t % tickEvery == 0 ) {
+      b.tick();
+      for (ButtonEvent e = b.getEvent(); e != BUTTON_NONE; e = b.getEvent()) {
+        gestures.push_back({ t, e });
+      }
+    }
+  }
+  button = 0;
+  return gestures;
+}
+
+static bool only(const std::vector<Gesture> &gestures, ButtonEvent event) {
+  return gestures.size() == 1 && gestures[0].event == event;
+}
+
+// A bouncing press and release make one click, 400 ms after the release settled.
+static void checkClick() {
+  std::vector<Gesture> g = play({ { 1000, 1 }, { 1002, 0 }, { 1004, 1 }, { 1100, 0 }, { 1103, 1 }, { 1105, 0 } });
+  CHECK(only(g, BUTTON_CLICK));
+  CHECK(g.size() == 1 && g[0].time == 1505);
+}
+
+// A spike shorter than the debounce time is not a press.
+static void checkGlitch() {
+  CHECK(play({ { 1000, 1 }, { 1020, 0 } }).empty());
+  CHECK(play({ { 1000, 1 }, { 1049, 0 } }).empty());
+  CHECK(only(play({ { 1000, 1 }, { 1050, 0 } }), BUTTON_CLICK));
+}
+
+static void checkDoubleClick() {
+  std::vector<Gesture> g = play({ { 1000, 1 }, { 1100, 0 }, { 1300, 1 }, { 1400, 0 } });
+  CHECK(only(g, BUTTON_DOUBLE_CLICK));
+  CHECK(g.size() == 1 && g[0].time == 1450);
+}
+
+// The second press starts just inside the double click time and is still bouncing when that time runs out.
+static void checkBounceInWindow() {
+  CHECK(only(play({ { 1000, 1 }, { 1100, 0 }, { 1480, 1 }, { 1482, 0 }, { 1484, 1 }, { 1600, 0 } }), BUTTON_DOUBLE_CLICK));
+  // Just outside it makes two clicks.
+  std::vector<Gesture> g = play({ { 1000, 1 }, { 1100, 0 }, { 1500, 1 }, { 1502, 0 }, { 1504, 1 }, { 1600, 0 } });
+  CHECK(g.size() == 2 && g[0].event == BUTTON_CLICK && g[1].event == BUTTON_CLICK);
+}
+
+static void checkLongPress() {
+  std::vector<Gesture> g = play({ { 1000, 1 }, { 2000, 0 } });
+  CHECK(only(g, BUTTON_LONG_PRESS_STOP));
+  CHECK(g.size() == 1 && g[0].time == 2050);
+  // A dropout while held does not break the press up.
+  CHECK(only(play({ { 1000, 1 }, { 1500, 0 }, { 1510, 1 }, { 2000, 0 } }), BUTTON_LONG_PRESS_STOP));
+  // Just short of the long press time it is a click.
+  CHECK(only(play({ { 1000, 1 }, { 1799, 0 } }), BUTTON_CLICK));
+}
+
+// With a loop pass only once per second the interrupt still sees every settled edge.
+static void checkLateTick() {
+  CHECK(only(play({ { 1000, 1 }, { 1100, 0 }, { 1300, 1 }, { 1400, 0 } }, 1000), BUTTON_DOUBLE_CLICK));
+  std::vector<Gesture> g = play({ { 1000, 1 }, { 1100, 0 }, { 1600, 1 }, { 1700, 0 } }, 1000);
+  CHECK(g.size() == 2 && g[0].event == BUTTON_CLICK && g[1].event == BUTTON_CLICK);
+  CHECK(only(play({ { 1000, 1 }, { 2000, 0 } }, 1000), BUTTON_LONG_PRESS_STOP));
+}
+
+int main() {
+  checkClick();
+  checkGlitch();
+  checkDoubleClick();
+  checkBounceInWindow();
+  checkLongPress();
+  checkLateTick();
+  return checkResult("button_check");
+}
@@ -0,0 +1,150 @@
+/*
+  Host check for the input trace: records inputs with InputTrace from
+  src/InputTrace.hpp through the host Serial and decodes them again with
+  traceDecode() from tools/host/Trace.hpp.
+*/
+
+#include <vector>
+
+#include "Arduino.h"
+#include "Trace.hpp"
+#include "Check.hpp"
+
+struct Edge {
+  unsigned long time;
+  int level;
+};
+
+// Everything comes back with its own timestamp, including deltas that need a varint.
+static void checkRoundTrip() {
+  host::reset();
+  host::now = 5000;
+  host::inputs[A2] = 1023;
+  host::inputs[A3] = 512;
+  host::inputs[A4] = 7;
+  InputTrace recorder(A5, A2, A3, A4);
+  recorder.begin(0xdeadbeef);
+
+  const unsigned long times[] = { 5005, 5010, 5040, 5041, 105041, 105100 };
+  for (unsigned long t = 5000; t <= 105100; t++) {
+    host::now = t;
+    for (unsigned long edge : times) {
+      if ( t == edge ) {
+        host::inputs[A5] = !host::inputs[A5];
+      }
+    }
+    if ( t == 5020 ) {
+      host::inputs[A3] = 0;
+    }
+    recorder.sample(t < 6000, t >= 6000);
+  }
+
+  // Noise in front of the header is skipped.
+  std::vector<uint8_t> capture = { 0x00, 0xff, 'C', 'M' };
+  capture.insert(capture.end(), host::serialOut.begin(), host::serialOut.end());
+  Trace trace;
+  std::string error;
+  CHECK(traceDecode(capture, trace, error));
+  CHECK(trace.seed == 0xdeadbeef);
+  CHECK(trace.start == 5000);
+  CHECK(trace.dropped == 0);
+
+  std::vector<Edge> edges;
+  std::vector<TraceEvent> analog;
+  std::vector<TraceEvent> states;
+  for (const TraceEvent &e : trace.events) {
+    if ( e.type == TRACE_TRIGGER_LOW || e.type == TRACE_TRIGGER_HIGH ) {
+      edges.push_back({ e.time, (int) e.value });
+    } else if ( e.type == TRACE_ANALOG ) {
+      analog.push_back(e);
+    } else if ( e.type == TRACE_STATE ) {
+      states.push_back(e);
+    }
+  }
+  // The first record is the initial LOW level, then one record per edge.
+  CHECK(edges.size() == 7);
+  if ( edges.size() == 7 ) {
+    CHECK(edges[0].time == 5000 && edges[0].level == LOW);
+    for (int i = 0; i < 6; i++) {
+      CHECK(edges[i + 1].time == times[i]);
+      CHECK(edges[i + 1].level == ( i % 2 == 0 ? HIGH : LOW ));
+    }
+  }
+  CHECK(analog.size() == 4);
+  if ( analog.size() == 4 ) {
+    CHECK(analog[0].channel == 0 && analog[0].value == 1023);
+    CHECK(analog[1].channel == 1 && analog[1].value == 512);
+    CHECK(analog[2].channel == 2 && analog[2].value == 7);
+    CHECK(analog[3].time == 5020 && analog[3].channel == 1 && analog[3].value == 0);
+  }
+  CHECK(states.size() == 2);
+  if ( states.size() == 2 ) {
+    CHECK(states[0].value == TRACE_STATE_CLOCK_MULTIPLIER);
+    CHECK(states[1].time == 6000 && states[1].value == TRACE_STATE_MUTED);
+  }
+
+  // A record cut off at the end of the capture is ignored.
+  capture.pop_back();
+  CHECK(traceDecode(capture, trace, error));
+}
+
+// With a Serial buffer that is full 75% of the time, edges are delayed but keep their timestamps,
+// and the ones that did not fit in the queue are counted in TRACE_DROPPED.
+static void checkBusyLink() {
+  host::reset();
+  host::now = 1000;
+  InputTrace recorder(A5, A2, A3, A4);
+  recorder.begin(1);
+
+  std::vector<Edge> seen;
+  int level = LOW;
+  for (unsigned long t = 1000; t < 3000; t++) {
+    host::now = t;
+    if ( t > 1000 && t % 2 == 0 ) {
+      level = !level;
+      seen.push_back({ t, level });
+    }
+    host::inputs[A5] = level;
+    host::serialRoom = ( t % 40 < 30 ) ? 0 : 64;
+    recorder.sample(true, false);
+  }
+  // Let the queue drain.
+  host::serialRoom = 64;
+  for (unsigned long t = 3000; t < 3010; t++) {
+    host::now = t;
+    recorder.sample(true, false);
+  }
+
+  Trace trace;
+  std::string error;
+  CHECK(traceDecode(host::serialOut, trace, error));
+
+  std::vector<Edge> written;
+  unsigned long previous = 0;
+  bool ordered = true;
+  for (const TraceEvent &e : trace.events) {
+    ordered = ordered && ( e.time >= previous );
+    previous = e.time;
+    if ( ( e.type == TRACE_TRIGGER_LOW || e.type == TRACE_TRIGGER_HIGH ) && e.time > 1000 ) {
+      written.push_back({ e.time, (int) e.value });
+    }
+  }
+  CHECK(ordered);
+  CHECK(trace.dropped > 0);
+  CHECK(written.size() + trace.dropped == seen.size());
+
+  // Every written edge is one that was seen, at the time it was seen.
+  size_t j = 0;
+  for (const Edge &w : written) {
+    while ( j < seen.size() && seen[j].time != w.time ) {
+      j++;
+    }
+    CHECK(j < seen.size() && seen[j].level == w.level);
+  }
+}
+
+int main() {
+  checkRoundTrip();
+  checkBusyLink();
+  return checkResult("trace_check");
+}
@@ -0,0 +1,131 @@
+#ifndef _HOST_ARDUINO
+#define _HOST_ARDUINO
+
+/*
+ * Host stand-in for the parts of the Arduino core the firmware uses, so that
+ * the engines, InputTrace.hpp and Button.hpp compile unchanged on a PC.
+ *
+ * Time only moves when the harness sets host::now. Inputs are whatever the
+ * harness puts in host::inputs, outputs land in host::outputs. Attached
+ * interrupts are not raised by themselves, the harness calls host::isrs.
+ * random() and randomSeed() follow avr-libc and the Arduino core, so a
+ * pattern computed from a recorded seed is the same pattern the module played.
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+
+#define PI 3.1415926535897932384626433832795
+
+// Arduino Nano pin numbers.
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define NUM_PINS 20
+
+namespace host {
+  inline unsigned long now = 0;      // The virtual clock in milliseconds.
+  inline int inputs[NUM_PINS];       // Digital levels or 10 bit analog values.
+  inline int outputs[NUM_PINS];      // The latest value written by digitalWrite() or analogWrite().
+  inline uint32_t randomState = 1;   // avr-libc starts with 1.
+  inline std::vector<uint8_t> serialOut;
+  inline int serialRoom = 64;        // What Serial.availableForWrite() reports.
+  inline void (*isrs[2])() = {};     // Handlers for INT0 (D2) and INT1 (D3).
+
+  // avr-libc do_random(): Park-Miller minimal standard generator.
+  inline long nextRandom() {
+    int32_t x = randomState;
+    if ( x == 0 ) {
+      x = 123459876L;
+    }
+    int32_t hi = x / 127773L;
+    int32_t lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if ( x < 0 ) {
+      x += 0x7fffffffL;
+    }
+    randomState = x;
+    return x % ( (uint32_t) 0x7fffffffL + 1 );
+  }
+
+  inline void reset() {
+    now = 0;
+    for (int i = 0; i < NUM_PINS; i++) {
+      inputs[i] = 0;
+      outputs[i] = 0;
+    }
+    randomState = 1;
+    serialOut.clear();
+    serialRoom = 64;
+    isrs[0] = isrs[1] = 0;
+  }
+}
+
+inline unsigned long millis() { return host::now; }
+inline unsigned long micros() { return host::now * 1000; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t pin) { return host::inputs[pin] ? HIGH : LOW; }
+inline int analogRead(uint8_t pin) { return host::inputs[pin]; }
+inline void digitalWrite(uint8_t pin, uint8_t value) { host::outputs[pin] = value; }
+inline void analogWrite(uint8_t pin, int value) { host::outputs[pin] = value; }
+
+inline int digitalPinToInterrupt(uint8_t pin) { return pin == 2 ? 0 : pin == 3 ? 1 : -1; }
+inline void attachInterrupt(int interrupt, void (*isr)(), int) { host::isrs[interrupt] = isr; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return ( x - in_min ) * ( out_max - out_min ) / ( in_max - in_min ) + out_min;
+}
+
+inline void randomSeed(unsigned long seed) {
+  if ( seed != 0 ) {
+    host::randomState = seed;
+  }
+}
+
+inline long random(long howbig) {
+  if ( howbig == 0 ) {
+    return 0;
+  }
+  return host::nextRandom() % howbig;
+}
+
+inline long random(long howsmall, long howbig) {
+  if ( howsmall >= howbig ) {
+    return howsmall;
+  }
+  return random(howbig - howsmall) + howsmall;
+}
+
+class HostSerial {
+
+  public:
+    void begin(unsigned long) {}
+    int availableForWrite() { return host::serialRoom; }
+    size_t write(const uint8_t *buf, size_t n) {
+      host::serialOut.insert(host::serialOut.end(), buf, buf + n);
+      return n;
+    }
+};
+
+inline HostSerial Serial;
+
+#endif
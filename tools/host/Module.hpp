@@ -0,0 +1,152 @@
+#ifndef _HOST_MODULE
+#define _HOST_MODULE
+
+/*
+ * The module on the host: both engines wired to the pins used in src/main.cpp,
+ * the mode and mute state that main.cpp keeps, and a loop that runs them
+ * against the virtual clock in tools/host/Arduino.h.
+ */
+
+#include <new>
+
+#include "Arduino.h"
+#include "Trace.hpp"
+
+#define debug_begin(x)
+#define debug_print(x)
+#define debug_print2(x, y)
+#define debug_print3(x, y, z)
+
+// The engines spell out the widths that matter on the ATmega328: cycleTime is an int16_t and the
+// easing is computed in float (double is a 32 bit float there), so overflows and rounding of the
+// values they store match the module. What is left over: int is 32 bits on the host, so
+// intermediate int arithmetic does not overflow where it would on the module; long is 64 bits,
+// which only matters once millis() wraps after 49 days; PI, cos(), sin() and pow() compute in
+// host double before the result is stored in a float.
+#include "ClockMultiplier.hpp"
+#include "RandomTriggers.hpp"
+
+static_assert(sizeof(float) == 4, "the engines need a 32 bit float like the ATmega328's double");
+
+class Module {
+
+  private:
+    // Storage for the engines, they are constructed once the virtual hardware is set up.
+    alignas(ClockMultiplier) unsigned char clockMultiplierStorage[sizeof(ClockMultiplier)];
+    alignas(RandomTriggers) unsigned char randomTriggersStorage[sizeof(RandomTriggers)];
+
+  public:
+    // Pin assignment as in src/main.cpp.
+    static const int triggerInPin = A5;
+    static const int triggerInLEDPin = 3;
+    static const int quantityPotiPin = A3;
+    static const int quantityCVPin = A4;
+    static const int distributionPotiPin = A2;
+    static const int triggerOutLEDPin = 5;
+    static const int triggerOutPin = 6;
+    static const int densitiyPotiPin = A2;
+    static const int lengthPotiPin = A3;
+
+    // The analog pins in trace channel order, see InputTrace in src/main.cpp.
+    static constexpr int analogPins[TRACE_CHANNELS] = { distributionPotiPin, quantityPotiPin, quantityCVPin };
+
+    enum Engine { FOLLOW_TRACE, CLOCK_MULTIPLIER, RANDOM_TRIGGERS };
+
+    ClockMultiplier *clockMultiplier;
+    RandomTriggers *randomTriggers;
+
+    Engine engine = FOLLOW_TRACE;
+    bool inClockMultiplierMode = true;
+    bool inMutedState = false;
+
+    // Resets the virtual hardware. analogRead(0) returns seed while RandomTriggers seeds random().
+    Module(unsigned long seed, unsigned long start, Engine _engine = FOLLOW_TRACE): engine(_engine) {
+      host::reset();
+      host::now = start;
+      host::inputs[0] = seed;
+      clockMultiplier = new (clockMultiplierStorage) ClockMultiplier(triggerInPin,
+                                                                      triggerInLEDPin,
+                                                                      quantityPotiPin,
+                                                                      quantityCVPin,
+                                                                      distributionPotiPin,
+                                                                      triggerOutLEDPin,
+                                                                      triggerOutPin);
+      randomTriggers = new (randomTriggersStorage) RandomTriggers(triggerInLEDPin,
+                                                                   triggerInPin,
+                                                                   densitiyPotiPin,
+                                                                   lengthPotiPin,
+                                                                   triggerOutLEDPin,
+                                                                   triggerOutPin);
+      host::inputs[0] = 0;
+      // Nothing has been written yet, the trigger out idles HIGH (inverted).
+      host::outputs[triggerOutPin] = HIGH;
+    }
+
+    ~Module() {
+      clockMultiplier->~ClockMultiplier();
+      randomTriggers->~RandomTriggers();
+    }
+
+    Module(const Module &) = delete;
+    Module &operator=(const Module &) = delete;
+
+    bool clockMultiplierActive() const {
+      return engine == FOLLOW_TRACE ? inClockMultiplierMode : engine == CLOCK_MULTIPLIER;
+    }
+
+    void apply(const TraceEvent &e) {
+      switch (e.type) {
+        case TRACE_TRIGGER_LOW:
+        case TRACE_TRIGGER_HIGH:
+          host::inputs[triggerInPin] = e.value;
+          break;
+        case TRACE_ANALOG:
+          host::inputs[analogPins[e.channel]] = e.value;
+          break;
+        case TRACE_STATE:
+          inClockMultiplierMode = e.value & TRACE_STATE_CLOCK_MULTIPLIER;
+          inMutedState = e.value & TRACE_STATE_MUTED;
+          break;
+        default:
+          break;
+      }
+    }
+
+    // One pass of loop() in src/main.cpp.
+    void tick() {
+      if ( clockMultiplierActive() ) {
+        clockMultiplier->tick(inMutedState);
+      } else {
+        randomTriggers->tick();
+      }
+    }
+
+    // The logical trigger out; the pin itself is inverted by the output transistor.
+    bool triggerOut() const {
+      return host::outputs[triggerOutPin] == LOW;
+    }
+
+    // Run the whole trace plus tail milliseconds with one loop pass every passMicros microseconds,
+    // so 1000 is one pass per millisecond and anything above it is a loop slower than that.
+    // onEdge(time, level) is called for every trigger out change.
+    template <typename F>
+    void run(const Trace &trace, unsigned long passMicros, unsigned long tail, F onEdge) {
+      size_t next = 0;
+      bool out = triggerOut();
+      unsigned long long end = ( trace.end() + tail ) * 1000ULL + 999;
+      for (unsigned long long us = trace.start * 1000ULL; us <= end; us += passMicros) {
+        unsigned long t = us / 1000;
+        host::now = t;
+        while ( next < trace.events.size() && trace.events[next].time <= t ) {
+          apply(trace.events[next++]);
+        }
+        tick();
+        if ( triggerOut() != out ) {
+          out = !out;
+          onEdge(t, out);
+        }
+      }
+    }
+};
+
+#endif
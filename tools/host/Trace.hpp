@@ -0,0 +1,145 @@
+#ifndef _HOST_TRACE
+#define _HOST_TRACE
+
+/*
+ * Decoder for the input trace written by src/InputTrace.hpp.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "InputTrace.hpp"
+
+struct TraceEvent {
+  unsigned long time; // Absolute millis() on the module.
+  uint8_t type;       // One of the TRACE_* record types.
+  uint8_t channel;    // TRACE_ANALOG only.
+  unsigned long value; // Analog value, state bits or dropped count.
+};
+
+struct Trace {
+  unsigned long seed = 0;
+  unsigned long start = 0;
+  unsigned long dropped = 0; // Trigger in edges lost on the module, the sum of all TRACE_DROPPED records.
+  std::vector<TraceEvent> events;
+
+  unsigned long end() const {
+    return events.empty() ? start : events.back().time;
+  }
+};
+
+// Read a varint at buf[pos], advance pos. Return false when the data ends early.
+inline bool traceDecodeVarint(const std::vector<uint8_t> &buf, size_t &pos, unsigned long &v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if ( pos >= buf.size() ) {
+      return false;
+    }
+    uint8_t b = buf[pos++];
+    v |= (unsigned long) ( b & 0x7f ) << shift;
+    if ( !( b & 0x80 ) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Decode a captured stream. Anything before the header (boot noise on the serial line) is skipped.
+// A record cut off at the end of the capture is ignored. Returns false and sets error on bad data.
+inline bool traceDecode(const std::vector<uint8_t> &buf, Trace &trace, std::string &error) {
+  size_t pos = 0;
+  while ( pos + TRACE_HEADER_SIZE <= buf.size() &&
+          !( buf[pos] == 'C' && buf[pos + 1] == 'M' && buf[pos + 2] == 'R' && buf[pos + 3] == 'T' ) ) {
+    pos++;
+  }
+  if ( pos + TRACE_HEADER_SIZE > buf.size() ) {
+    error = "no trace header found";
+    return false;
+  }
+  if ( buf[pos + 4] != TRACE_VERSION ) {
+    error = "unsupported trace version " + std::to_string(buf[pos + 4]);
+    return false;
+  }
+  trace.seed = 0;
+  trace.start = 0;
+  for (int i = 0; i < 4; i++) {
+    trace.seed |= (unsigned long) buf[pos + 5 + i] << ( 8 * i );
+    trace.start |= (unsigned long) buf[pos + 9 + i] << ( 8 * i );
+  }
+  pos += TRACE_HEADER_SIZE;
+
+  unsigned long time = trace.start;
+  trace.events.clear();
+  trace.dropped = 0;
+  while ( pos < buf.size() ) {
+    TraceEvent e = {0, 0, 0, 0};
+    uint8_t b = buf[pos++];
+    unsigned long delta = b & TRACE_SHORT_DELTA;
+    e.type = b >> 5;
+    if ( delta == TRACE_SHORT_DELTA ) {
+      unsigned long rest;
+      if ( !traceDecodeVarint(buf, pos, rest) ) {
+        break;
+      }
+      delta += rest;
+    }
+    time += delta;
+    e.time = time;
+    switch (e.type) {
+      case TRACE_TRIGGER_LOW:
+      case TRACE_TRIGGER_HIGH:
+        e.value = e.type == TRACE_TRIGGER_HIGH;
+        break;
+      case TRACE_ANALOG:
+        if ( pos + 2 > buf.size() ) {
+          return true;
+        }
+        e.channel = buf[pos] >> 2;
+        e.value = ( ( buf[pos] & 0x03 ) << 8 ) | buf[pos + 1];
+        pos += 2;
+        if ( e.channel >= TRACE_CHANNELS ) {
+          error = "bad analog channel at byte " + std::to_string(pos - 2);
+          return false;
+        }
+        break;
+      case TRACE_STATE:
+        if ( pos + 1 > buf.size() ) {
+          return true;
+        }
+        e.value = buf[pos++];
+        break;
+      case TRACE_DROPPED:
+        if ( !traceDecodeVarint(buf, pos, e.value) ) {
+          return true;
+        }
+        trace.dropped += e.value;
+        break;
+      default:
+        error = "unknown record type " + std::to_string(e.type) + " at byte " + std::to_string(pos - 1);
+        return false;
+    }
+    trace.events.push_back(e);
+  }
+  return true;
+}
+
+inline bool traceLoad(const char *path, Trace &trace, std::string &error) {
+  FILE *f = fopen(path, "rb");
+  if ( !f ) {
+    error = std::string("cannot open ") + path;
+    return false;
+  }
+  std::vector<uint8_t> buf;
+  uint8_t chunk[65536];
+  size_t n;
+  while ( ( n = fread(chunk, 1, sizeof(chunk), f) ) > 0 ) {
+    buf.insert(buf.end(), chunk, chunk + n);
+  }
+  fclose(f);
+  return traceDecode(buf, trace, error);
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+  Offline replay of an input trace captured with TRACE defined in src/main.cpp.
+
+  Feeds the recorded trigger, poti/CV and mode/mute changes into the engines
+  against a virtual clock and writes the resulting trigger out timeline, one
+  edge per line:
+
+    <millis> <clock|random> <1|0>
+
+  Usage: replay [--engine trace|clock|random] [--pass-us n] [--tail ms] trace.bin [timeline.txt]
+
+    --engine        trace (default) follows the recorded mode, clock or random runs one engine
+                    for the whole trace.
+    --pass-us       Duration of one loop pass in microseconds, default 1000. Use more than 1000
+                    to see what a slower loop does to the timing.
+    --tail          Milliseconds to keep running after the last event, default 1000.
+*/
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Module.hpp"
+
+static void usage() {
+  fprintf(stderr, "usage: replay [--engine trace|clock|random] [--pass-us n] [--tail ms] trace.bin [timeline.txt]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  Module::Engine engine = Module::FOLLOW_TRACE;
+  unsigned long passMicros = 1000;
+  unsigned long tail = 1000;
+  const char *tracePath = 0;
+  const char *outPath = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if ( !strcmp(argv[i], "--engine") && i + 1 < argc ) {
+      const char *e = argv[++i];
+      if ( !strcmp(e, "trace") ) {
+        engine = Module::FOLLOW_TRACE;
+      } else if ( !strcmp(e, "clock") ) {
+        engine = Module::CLOCK_MULTIPLIER;
+      } else if ( !strcmp(e, "random") ) {
+        engine = Module::RANDOM_TRIGGERS;
+      } else {
+        usage();
+      }
+    } else if ( !strcmp(argv[i], "--pass-us") && i + 1 < argc ) {
+      passMicros = strtoul(argv[++i], 0, 10);
+      if ( passMicros < 1 ) {
+        usage();
+      }
+    } else if ( !strcmp(argv[i], "--tail") && i + 1 < argc ) {
+      tail = strtoul(argv[++i], 0, 10);
+    } else if ( argv[i][0] == '-' ) {
+      usage();
+    } else if ( !tracePath ) {
+      tracePath = argv[i];
+    } else if ( !outPath ) {
+      outPath = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if ( !tracePath ) {
+    usage();
+  }
+
+  Trace trace;
+  std::string error;
+  if ( !traceLoad(tracePath, trace, error) ) {
+    fprintf(stderr, "replay: %s: %s\n", tracePath, error.c_str());
+    return 1;
+  }
+  if ( trace.dropped > 0 ) {
+    fprintf(stderr, "replay: warning: %lu trigger in edges were lost to a full serial buffer\n", trace.dropped);
+  }
+
+  FILE *out = stdout;
+  if ( outPath ) {
+    out = fopen(outPath, "w");
+    if ( !out ) {
+      fprintf(stderr, "replay: cannot open %s\n", outPath);
+      return 1;
+    }
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  Module module(trace.seed, trace.start, engine);
+  unsigned long edges = 0;
+  module.run(trace, passMicros, tail, [&](unsigned long t, bool level) {
+    fprintf(out, "%lu %s %d\n", t, module.clockMultiplierActive() ? "clock" : "random", level);
+    edges++;
+  });
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  if ( out != stdout ) {
+    fclose(out);
+  }
+  fprintf(stderr, "replay: %zu events, %.1f s of input, %lu output edges, replayed in %.2f s\n",
+          trace.events.size(), ( trace.end() - trace.start ) / 1000.0, edges, elapsed);
+  return 0;
+}